@@ -1,12 +1,17 @@
 #pragma once
 
+#include "async_framework/MessagePool.h"
+#include "threads/Executor.h"
 #include "threads/SingleThread.h"
+#include "threads/ThreadPool.h"
 #include "common/macros.h"
 
 #include <memory> 
 #include <unordered_map> 
 #include <unordered_set> 
 #include <functional>
+#include <mutex>
+#include <condition_variable>
 
 struct PairID {
     size_t first_;
@@ -51,6 +56,8 @@ public:
     using MessageBasePtr = std::shared_ptr<MessageBase>;
 
     static std::shared_ptr<AsyncSystem> getInstance();
+    // Shared pool for reentrant callback groups, created on first use.
+    std::shared_ptr<ThreadPool> getThreadPool();
     
     size_t addPublisher(const std::string& topic_name);
     size_t addSubscriber(const std::string& topic_name, std::shared_ptr<MessageReceiver> subscriber);
@@ -71,31 +78,128 @@ private:
     std::unordered_set<size_t> requests_;
     std::unordered_map<PairID, std::shared_ptr<ResponseReceiver>, PairID> requesters_;
     std::unordered_map<size_t, std::shared_ptr<RequestReceiver>> responders_;
+
+    std::mutex thread_pool_mutex_;
+    std::shared_ptr<ThreadPool> thread_pool_;
 };
 
+// Defines how the handlers of the group are executed.
+// MUTUALLY_EXCLUSIVE - handlers are serialized with all other exclusive handlers of the node on the node executor.
+// REENTRANT - handlers are executed in parallel on the thread pool, even the same handler for different messages.
+class CallbackGroup {
+public:
+    enum Type {
+        MUTUALLY_EXCLUSIVE,
+        REENTRANT,
+    };
+
+    CallbackGroup(Type type, Executor* executor, std::shared_ptr<ThreadPool> thread_pool);
+
+    Type type() const noexcept {
+        return type_;
+    }
+
+    void addTask(std::function<void()> task) noexcept;
+    // Drop new reentrant tasks and wait for completion of the tasks in flight.
+    void shutdown() noexcept;
+private:
+    Type type_;
+    bool closed_ = false;
+    Executor* executor_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    size_t tasks_in_flight_ = 0;  // guarded by wait_mutex_
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+};
 
 
-class AsyncNode : public SingleThread {
+
+class AsyncNode {
 public:
     using MessageBasePtr = std::shared_ptr<MessageBase>;
+    using TimePoint = Executor::TimePoint;
+    using Duration = Executor::Duration;
+
+    // All handlers of the node are executed by the executor, by default on its own thread.
+    AsyncNode(std::shared_ptr<Executor> executor = std::make_shared<SingleThread>());
+    // Calls shutdownCallbackGroups(), but reentrant handlers using members of a derived node
+    // must be stopped by the derived destructor.
+    ~AsyncNode();
 
-    AsyncNode();
+    void addTask(std::function<void()> task) noexcept;
+    // Execute the task in the callback group, or on the node executor if group is nullptr.
+    void addTask(std::function<void()> task, CallbackGroup* group) noexcept;
+    // Current time of the node executor clock, use it instead of the system clock.
+    TimePoint now() const noexcept;
 
     void sendMessage(size_t topic_id, std::shared_ptr<MessageBase> msg) noexcept;
     void sendRequest(PairID request_id, MessageBasePtr request) noexcept;
     void sendResponse(PairID request_id, MessageBasePtr request, MessageBasePtr responce) noexcept;
+
+    // Borrow a preallocated message from the topic pool, fill it in place and send it with sendMessage(...).
+    // The message is returned into the pool when the last subscriber releases it.
+    template<typename MessageT>
+    std::shared_ptr<MessageT> loanMessage(size_t topic_id) {
+        auto itr = message_pools_.find(topic_id);
+        ASSERT(message_pools_.end() != itr, "AsyncNode::loanMessage(...): No message pool for the topic ID.");
+        auto pool = dynamic_cast<MessagePool<MessageT>*>(itr->second.get());
+        ASSERT(pool != nullptr, "AsyncNode::loanMessage(...): Message type doesn't match the topic pool type.");
+        return pool->loan();
+    }
+
+    // Total number of preallocated messages of the topic pool, grows if the pool runs out of messages.
+    size_t messagePoolCapacity(size_t topic_id) const;
 protected:
     size_t addPublisher(const std::string& topic_name);
+    // Publisher with a pool of pool_size preallocated messages, see loanMessage(...).
+    template<typename MessageT>
+    size_t addPublisher(const std::string& topic_name, size_t pool_size) {
+        const size_t topic_id = addPublisher(topic_name);
+        message_pools_[topic_id] = std::make_shared<MessagePool<MessageT>>(pool_size);
+        return topic_id;
+    }
     size_t addSubscriber(const std::string& topic_name, std::shared_ptr<MessageReceiver> subscriber);
     PairID addRequest(
         const std::string& request_topic_name, 
         const std::string& responder_name, 
         std::shared_ptr<ResponseReceiver> request_handler);
     size_t addResponse(const std::string& topic_name, std::shared_ptr<RequestReceiver> request_handler);
-    
+    // Group for handlers, passed into AsyncSubscriber, AsyncRequestHandler and AsyncResponseHandler.
+    // Reentrant groups use the thread_pool or the AsyncSystem shared pool if it's nullptr.
+    // The thread pool must outlive the node.
+    // A node with reentrant groups must call shutdownCallbackGroups() first in its destructor,
+    // reentrant handlers run on the pool threads and may still use the node members.
+    // Reentrant handlers run on real threads outside of the executor, so with VirtualTimeScheduler
+    // they don't follow the virtual clock and break the deterministic order, use exclusive groups there.
+    std::shared_ptr<CallbackGroup> createCallbackGroup(
+        CallbackGroup::Type type, 
+        std::shared_ptr<ThreadPool> thread_pool = nullptr);
+    // Drop new messages of reentrant groups and wait for the running reentrant handlers.
+    void shutdownCallbackGroups() noexcept;
+    // Call the callback periodically, first call is after one period.
+    void addTimer(Duration period, std::function<void()> callback);
     
 private:   
     std::shared_ptr<AsyncSystem> system_;  
+    std::shared_ptr<Executor> executor_;
+    std::unordered_map<size_t, std::shared_ptr<MessagePoolBase>> message_pools_;
+    std::vector<std::shared_ptr<CallbackGroup>> callback_groups_;
+
+    // Timers may outlive the node on a shared executor, they are called only while the node is alive
+    struct TimerToken {
+        std::recursive_mutex mutex_;
+        bool alive_ = true;
+    };
+
+    std::shared_ptr<TimerToken> timer_token_;
+
+    static void scheduleTimer(
+        Executor* executor, 
+        std::shared_ptr<TimerToken> token, 
+        TimePoint time, 
+        Duration period, 
+        std::shared_ptr<std::function<void()>> callback);
 };
 
 
@@ -105,9 +209,10 @@ public:
     using MessagePtrT = std::shared_ptr<MessageT>;
     using MsgHandlerT = std::function<void(const MessagePtrT& msg)>;
 
-    AsyncSubscriber(AsyncNode* node, MsgHandlerT msg_handler) 
+    AsyncSubscriber(AsyncNode* node, MsgHandlerT msg_handler, std::shared_ptr<CallbackGroup> group = nullptr) 
     : node_(node) 
-    , msg_handler_(msg_handler) {
+    , msg_handler_(msg_handler)
+    , group_(std::move(group)) {
     }
 
     void writeMessage(const std::shared_ptr<MessageBase>& msg) override {
@@ -115,11 +220,12 @@ public:
             msg_handler_(std::move(std::static_pointer_cast<MessageT>(msg)));
         };
 
-        node_->addTask(task_body);
+        node_->addTask(task_body, group_.get());
     }
 private:
     AsyncNode* node_;
     MsgHandlerT msg_handler_;
+    std::shared_ptr<CallbackGroup> group_;
 };
 
 template<typename RequestMsgT, typename ResponseMsgT>
@@ -129,9 +235,10 @@ public:
     using ResponseMsgPtrT = std::shared_ptr<ResponseMsgT>;
     using ResponseMsgHandlerT = std::function<void(const RequestMsgPtrT& request, const ResponseMsgPtrT& responce)>;
 
-    AsyncResponseHandler(AsyncNode* node, ResponseMsgHandlerT response_handler) 
+    AsyncResponseHandler(AsyncNode* node, ResponseMsgHandlerT response_handler, std::shared_ptr<CallbackGroup> group = nullptr) 
     : node_(node) 
-    , response_handler_(response_handler) {
+    , response_handler_(response_handler)
+    , group_(std::move(group)) {
     }
 
     void writeResponse(const MessageBasePtr& request, const MessageBasePtr& responce) override {
@@ -141,12 +248,13 @@ public:
                 std::move(std::static_pointer_cast<ResponseMsgT>(responce)));
         };
 
-        node_->addTask(task_body);
+        node_->addTask(task_body, group_.get());
     }
 
 private:
     AsyncNode* node_;
     ResponseMsgHandlerT response_handler_;
+    std::shared_ptr<CallbackGroup> group_;
 };
 
 template<typename RequestMsgT, typename ResponseMsgT>
@@ -157,9 +265,10 @@ public:
     using RequestHandlerT = std::function<ResponseMsgPtrT(const RequestMsgPtrT& request)>;
 
 
-    AsyncRequestHandler(AsyncNode* node, RequestHandlerT request_handler) 
+    AsyncRequestHandler(AsyncNode* node, RequestHandlerT request_handler, std::shared_ptr<CallbackGroup> group = nullptr) 
     : node_(node) 
-    , request_handler_(request_handler) {
+    , request_handler_(request_handler)
+    , group_(std::move(group)) {
     }
 
     void writeRequest(PairID request_id, const MessageBasePtr& request) override {
@@ -168,11 +277,12 @@ public:
             node_->sendResponse(request_id, std::move(request), std::move(response));
         };
 
-        node_->addTask(task_body);
+        node_->addTask(task_body, group_.get());
         
     }
 
 private:
     AsyncNode* node_;
     RequestHandlerT request_handler_;
+    std::shared_ptr<CallbackGroup> group_;
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "common/macros.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+// Type erased base, to keep pools of different message types in one container.
+class MessagePoolBase {
+public:
+    virtual ~MessagePoolBase() = default;
+
+    virtual size_t capacity() const = 0;
+    virtual size_t available() const = 0;
+};
+
+// Pool of preallocated messages for publishers of large payloads.
+// loan() returns a shared pointer to an already constructed message, the message is not reset,
+// so its buffers keep their capacity between loans and should be filled in place.
+// When the last owner releases the message, it goes back to the pool. The shared pointer control
+// block is placed into the pool slot too, so no memory is allocated while the pool has free messages.
+// If the pool is empty, it grows by the initial size.
+// Messages are aligned to Alignment bytes (cache line, SIMD friendly) and may outlive the pool.
+template<typename MessageT, size_t Alignment = 64>
+class MessagePool : public MessagePoolBase {
+public:
+    using MessagePtrT = std::shared_ptr<MessageT>;
+
+    static_assert(std::is_default_constructible_v<MessageT>, "Pooled message must be default constructible.");
+
+    MessagePool(size_t size)
+    : state_(std::make_shared<State>()) {
+        ASSERT(size > 0, "MessagePool::MessagePool(...): Invalid pool size.");
+        state_->chunk_size_ = size;
+        state_->grow();
+    }
+
+    MessagePtrT loan() {
+        Slot* slot = state_->acquire();
+        return MessagePtrT(&slot->message_, NoDelete(), SlotAllocator<MessageT>(state_, slot));
+    }
+
+    // Total number of preallocated messages.
+    size_t capacity() const override {
+        std::unique_lock<std::mutex> lock(state_->mutex_);
+        return state_->capacity_;
+    }
+
+    // Number of messages not on loan.
+    size_t available() const override {
+        std::unique_lock<std::mutex> lock(state_->mutex_);
+        return state_->free_slots_.size();
+    }
+private:
+    // Enough for the libstdc++/libc++ control block with SlotAllocator inside.
+    static constexpr size_t CONTROL_BLOCK_SIZE = 64;
+
+    static constexpr size_t SLOT_ALIGNMENT = Alignment > alignof(MessageT) ? Alignment : alignof(MessageT);
+
+    struct alignas(SLOT_ALIGNMENT) Slot {
+        MessageT message_;
+        alignas(std::max_align_t) std::byte control_block_[CONTROL_BLOCK_SIZE];
+    };
+
+    static_assert(alignof(Slot) >= Alignment, "MessagePool: invalid slot alignment.");
+
+    struct State {
+        std::mutex mutex_;
+        size_t chunk_size_ = 0;
+        size_t capacity_ = 0;
+        std::vector<std::unique_ptr<Slot[]>> chunks_;
+        std::vector<Slot*> free_slots_;
+
+        // Expects mutex_ to be locked or the state to be not shared yet
+        void grow() {
+            chunks_.emplace_back(new Slot[chunk_size_]);
+            capacity_ += chunk_size_;
+            free_slots_.reserve(capacity_);
+            for(size_t i = 0; i < chunk_size_; ++i) {
+                free_slots_.push_back(&chunks_.back()[i]);
+            }
+        }
+
+        Slot* acquire() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if UNLIKELY(free_slots_.empty()) {
+                grow();
+            }
+
+            Slot* slot = free_slots_.back();
+            free_slots_.pop_back();
+            return slot;
+        }
+
+        void release(Slot* slot) noexcept {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Never reallocates, capacity is reserved in grow()
+            free_slots_.push_back(slot);
+        }
+    };
+
+    // The message itself lives as long as the pool slot.
+    struct NoDelete {
+        void operator() (MessageT*) const noexcept {}
+    };
+
+    // Places the shared pointer control block into the slot and returns the slot into the pool
+    // when the control block is destroyed, i.e. after the last shared and weak pointer is gone.
+    template<typename T>
+    struct SlotAllocator {
+        using value_type = T;
+
+        std::shared_ptr<State> state_;
+        Slot* slot_;
+
+        SlotAllocator(std::shared_ptr<State> state, Slot* slot)
+        : state_(std::move(state))
+        , slot_(slot) {
+        }
+
+        template<typename U>
+        SlotAllocator(const SlotAllocator<U>& other)
+        : state_(other.state_)
+        , slot_(other.slot_) {
+        }
+
+        T* allocate(size_t n) {
+            static_assert(sizeof(T) <= CONTROL_BLOCK_SIZE, "MessagePool: control block doesn't fit into the slot.");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "MessagePool: invalid control block alignment.");
+            ASSERT(1 == n, "MessagePool::SlotAllocator::allocate(...): Invalid allocation size.");
+            return reinterpret_cast<T*>(slot_->control_block_);
+        }
+
+        void deallocate(T*, size_t) noexcept {
+            state_->release(slot_);
+        }
+
+        template<typename U>
+        friend bool operator == (const SlotAllocator& left, const SlotAllocator<U>& right) {
+            return left.slot_ == right.slot_;
+        }
+
+        template<typename U>
+        friend bool operator != (const SlotAllocator& left, const SlotAllocator<U>& right) {
+            return left.slot_ != right.slot_;
+        }
+    };
+
+    std::shared_ptr<State> state_;
+};
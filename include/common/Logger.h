@@ -0,0 +1,215 @@
+#pragma once
+
+#include "common/macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR,
+};
+
+// Static description of a log call site, the record refers to it instead of copying the format string.
+// Format string uses "{}" as arguments placeholder.
+struct LogSite {
+    const LogLevel level_;
+    const char* const format_;
+    const char* const file_;
+    const int line_;
+    // Minimal interval between records of the site in nanoseconds, 0 - not limited
+    const int64_t rate_limit_ns_;
+
+    std::atomic<int64_t> next_time_ns_ = 0;
+    std::atomic<uint64_t> suppressed_ = 0;
+
+    constexpr LogSite(LogLevel level, const char* format, const char* file, int line, int64_t rate_limit_ns = 0)
+    : level_(level)
+    , format_(format)
+    , file_(file)
+    , line_(line)
+    , rate_limit_ns_(rate_limit_ns) {
+    }
+};
+
+// Compact binary log argument. Strings are stored as pointers, so only string literals
+// and other strings with static lifetime are allowed.
+struct LogArg {
+    enum Type : uint8_t {
+        BOOL,
+        INT,
+        UINT,
+        DOUBLE,
+        STRING,
+        POINTER,
+    };
+
+    Type type_;
+    union {
+        bool bool_;
+        int64_t int_;
+        uint64_t uint_;
+        double double_;
+        const char* string_;
+        const void* pointer_;
+    };
+};
+
+struct LogRecord {
+    static constexpr size_t MAX_ARGS = 6;
+
+    const LogSite* site_;
+    int64_t time_ns_;
+    uint64_t suppressed_;   // records of the site skipped by rate limit before this one
+    size_t args_count_;
+    LogArg args_[MAX_ARGS];
+};
+
+// Asynchronous logger. The calling thread only writes a LogRecord into its own lock-free
+// single producer/single consumer ring, the background thread formats and writes records.
+// If the ring is full the record is dropped, the number of dropped records is reported later.
+// Use LOG_... macros instead of direct calls.
+class Logger {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Logger& getInstance();
+
+    ~Logger();
+
+    template<typename... ArgsT>
+    void write(LogSite& site, const ArgsT&... args) noexcept {
+        static_assert(sizeof...(ArgsT) <= LogRecord::MAX_ARGS, "Too many log arguments.");
+
+        if (site.level_ < level_.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        LogRecord record;
+        record.site_ = &site;
+        record.time_ns_ = nowNs();
+        record.suppressed_ = 0;
+
+        if (site.rate_limit_ns_ > 0 && !checkRateLimit(site, record.time_ns_, record.suppressed_)) {
+            return;
+        }
+
+        record.args_count_ = 0;
+        (setArg(record.args_[record.args_count_++], args), ...);
+
+        push(record);
+    }
+
+    void setLevel(LogLevel level) noexcept {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    // Output stream for formatted records, std::cerr by default. The stream must outlive the logger.
+    void setOutput(std::ostream* output);
+
+    // Format and write all records logged before the call.
+    void flush();
+
+private:
+    class LogRing;
+
+    static constexpr size_t RING_SIZE = 1024; // records, power of 2
+    static constexpr auto FLUSH_PERIOD = std::chrono::milliseconds(10);
+
+    std::atomic<LogLevel> level_ = LogLevel::INFO;
+    const Clock::time_point start_time_ = Clock::now();
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+
+    std::mutex output_mutex_;   // held while the records are formatted
+    std::ostream* output_;
+    std::vector<LogRecord> batch_;
+
+    std::mutex thread_mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    Logger();
+
+    int64_t nowNs() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_).count();
+    }
+
+    static bool checkRateLimit(LogSite& site, int64_t time_ns, uint64_t& suppressed) noexcept {
+        int64_t next_time_ns = site.next_time_ns_.load(std::memory_order_relaxed);
+        if (time_ns < next_time_ns ||
+            !site.next_time_ns_.compare_exchange_strong(next_time_ns, time_ns + site.rate_limit_ns_, std::memory_order_relaxed)) {
+            site.suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        suppressed = site.suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    template<typename ArgT>
+    static void setArg(LogArg& arg, const ArgT& value) noexcept {
+        if constexpr (std::is_same_v<ArgT, bool>) {
+            arg.type_ = LogArg::BOOL;
+            arg.bool_ = value;
+        } else if constexpr (std::is_enum_v<ArgT>) {
+            setArg(arg, static_cast<std::underlying_type_t<ArgT>>(value));
+        } else if constexpr (std::is_integral_v<ArgT>) {
+            if constexpr (std::is_signed_v<ArgT>) {
+                arg.type_ = LogArg::INT;
+                arg.int_ = static_cast<int64_t>(value);
+            } else {
+                arg.type_ = LogArg::UINT;
+                arg.uint_ = static_cast<uint64_t>(value);
+            }
+        } else if constexpr (std::is_floating_point_v<ArgT>) {
+            arg.type_ = LogArg::DOUBLE;
+            arg.double_ = value;
+        } else if constexpr (std::is_convertible_v<ArgT, const char*>) {
+            arg.type_ = LogArg::STRING;
+            arg.string_ = value;
+        } else {
+            static_assert(std::is_pointer_v<ArgT>, "Unsupported log argument type.");
+            arg.type_ = LogArg::POINTER;
+            arg.pointer_ = value;
+        }
+    }
+
+    void push(const LogRecord& record) noexcept;
+    LogRing& threadRing();
+    void run();
+    // Expects output_mutex_ to be locked
+    void writeRecords();
+    void writeRecord(const LogRecord& record);
+};
+
+#define LOG(level, format, ...) \
+    do { \
+        static LogSite log_site_(level, format, __FILE__, __LINE__); \
+        Logger::getInstance().write(log_site_ __VA_OPT__(,) __VA_ARGS__); \
+    } while(false)
+
+// Log not more often than once per interval, the number of skipped records is reported with the next one.
+#define LOG_RATE_LIMITED(level, interval, format, ...) \
+    do { \
+        static LogSite log_site_(level, format, __FILE__, __LINE__, \
+            std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()); \
+        Logger::getInstance().write(log_site_ __VA_OPT__(,) __VA_ARGS__); \
+    } while(false)
+
+#define LOG_DEBUG(format, ...) LOG(LogLevel::DEBUG, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_INFO(format, ...) LOG(LogLevel::INFO, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_WARNING(format, ...) LOG(LogLevel::WARNING, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG(LogLevel::ERROR, format __VA_OPT__(,) __VA_ARGS__)
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "threads/Executor.h"
+#include "threads/TimerQueue.h"
+#include "common/macros.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <mutex>
+
+#include <queue>
+#include <vector>
+#include <unordered_map>
+
+// Single thread executor built around the epoll loop (Linux only).
+// Besides tasks and timers, the thread waits on registered file descriptors and calls their
+// handlers on the same thread, so a node can react to sockets, pipes and devices without helper threads.
+// The thread is woken up for new tasks by an eventfd registered in the same epoll instance.
+class EpollThread : public Executor {
+public:
+    using FdHandlerT = std::function<void(uint32_t events)>;
+
+    EpollThread() {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        ASSERT(epoll_fd_ >= 0, "EpollThread::EpollThread(): Failed to create epoll instance.");
+        event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ASSERT(event_fd_ >= 0, "EpollThread::EpollThread(): Failed to create eventfd.");
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = event_fd_;
+        ASSERT(0 == epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event),
+            "EpollThread::EpollThread(): Failed to register eventfd.");
+
+        thread_ = std::thread([this] {this->run();});
+    }
+
+    ~EpollThread() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Pending timers and file descriptors are dropped, only already queued tasks are finished.
+            state_ = FINISH_AND_STOP;
+            timed_tasks_.stop();
+        }
+
+        wakeUp();
+
+        thread_.join();
+
+        close(event_fd_);
+        close(epoll_fd_);
+    }
+
+    void addTask(std::function<void()> task) noexcept override {
+        bool was_empty;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            was_empty = tasks_.empty();
+            tasks_.emplace(std::move(task));
+        }
+
+        // The thread drains the whole queue before waiting, so wake up only on the first task
+        if (was_empty) {
+            wakeUp();
+        }
+    }
+
+    void addTimedTask(TimePoint time, std::function<void()> task) noexcept override {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            timed_tasks_.push(time, std::move(task));
+        }
+
+        // Timeout of the epoll wait may need to be shortened
+        wakeUp();
+    }
+
+    TimePoint now() const noexcept override {
+        return Clock::now();
+    }
+
+    // Call the handler on this thread when the fd is ready, events are EPOLLIN, EPOLLOUT, EPOLLET, etc.
+    // The fd is not owned, it must stay open until removeFd(...). Returns false and keeps errno on failure,
+    // an already registered fd fails with EEXIST and keeps its handler.
+    bool addFd(int fd, uint32_t events, FdHandlerT handler) noexcept {
+        std::unique_lock<std::recursive_mutex> lock(handlers_mutex_);
+        if UNLIKELY(fd_handlers_.count(fd) > 0) {
+            errno = EEXIST;
+            return false;
+        }
+
+        epoll_event event = {};
+        event.events = events;
+        event.data.fd = fd;
+        if UNLIKELY(0 != epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event)) {
+            return false;
+        }
+
+        fd_handlers_[fd] = std::make_shared<FdHandlerT>(std::move(handler));
+        return true;
+    }
+
+    // Change the events of the registered fd.
+    bool modifyFd(int fd, uint32_t events) noexcept {
+        epoll_event event = {};
+        event.events = events;
+        event.data.fd = fd;
+        return 0 == epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    // Waits for the running handler of the fd to finish, after the return the handler is never called.
+    // Can be called from the handler itself.
+    bool removeFd(int fd) noexcept {
+        std::unique_lock<std::recursive_mutex> lock(handlers_mutex_);
+        if UNLIKELY(0 == fd_handlers_.erase(fd)) {
+            errno = ENOENT;
+            return false;
+        }
+
+        return 0 == epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+private:
+    static constexpr int MAX_EVENTS = 64;
+
+    int epoll_fd_;
+    int event_fd_;
+    std::thread thread_;
+    std::queue<std::function<void()>> tasks_;
+    TimerQueue<> timed_tasks_;
+    std::mutex mutex_;
+    // Held while a handler runs, so handlers are not removed in the middle of the call
+    std::recursive_mutex handlers_mutex_;
+    std::unordered_map<int, std::shared_ptr<FdHandlerT>> fd_handlers_;
+
+    enum State {
+        RUN,
+        FINISH_AND_STOP,
+    };
+
+    State state_ = RUN;
+
+    void wakeUp() noexcept {
+        const uint64_t value = 1;
+        // Can fail only if the counter overflows, the thread is woken up anyway
+        [[maybe_unused]] const auto result = write(event_fd_, &value, sizeof(value));
+    }
+
+    void run() {
+        std::queue<std::function<void()>> tasks;
+        epoll_event events[MAX_EVENTS];
+
+        while(true) {
+            int timeout_ms = -1;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (tasks_.empty() && FINISH_AND_STOP == state_) {
+                    break;
+                }
+
+                // Move due timers into the tasks queue
+                const auto time = Clock::now();
+                timed_tasks_.popDue(time, [this](std::function<void()>&& task) {
+                    tasks_.emplace(std::move(task));
+                });
+
+                if (!tasks_.empty()) {
+                    std::swap(tasks, tasks_);
+                } else if (!timed_tasks_.empty()) {
+                    // Round up, to not wake up before the timer, and clamp far timers to the int range
+                    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(timed_tasks_.nextTime() - time).count();
+                    timeout_ms = static_cast<int>(std::min<decltype(timeout)>(timeout, std::numeric_limits<int>::max()));
+                }
+            }
+
+            // Tasks are ready, just poll the file descriptors
+            if (!tasks.empty()) {
+                timeout_ms = 0;
+            }
+
+            const int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+            for(int i = 0; i < count; ++i) {
+                const int fd = events[i].data.fd;
+                if (event_fd_ == fd) {
+                    uint64_t value;
+                    [[maybe_unused]] const auto result = read(event_fd_, &value, sizeof(value));
+                    continue;
+                }
+
+                std::unique_lock<std::recursive_mutex> lock(handlers_mutex_);
+                auto itr = fd_handlers_.find(fd);
+                if (fd_handlers_.end() == itr) {
+                    // Removed by a previous handler or another thread
+                    continue;
+                }
+
+                // Keep the handler alive, if it removes itself
+                const std::shared_ptr<FdHandlerT> handler = itr->second;
+                (*handler)(events[i].events);
+            }
+
+            while(!tasks.empty()) {
+                tasks.front()();
+                tasks.pop();
+            }
+        }
+    }
+};
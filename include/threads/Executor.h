@@ -0,0 +1,22 @@
+#pragma once
+
+#include <functional>
+#include <chrono>
+
+// Abstract task executor. AsyncNode posts all its handlers through this interface,
+// so the thread model (real thread, virtual time, ...) can be swapped per node.
+class Executor {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+
+    virtual ~Executor() = default;
+
+    // Run the task as soon as possible, tasks are executed in the order of submission.
+    virtual void addTask(std::function<void()> task) noexcept = 0;
+    // Run the task not earlier than at the given time of the executor clock.
+    virtual void addTimedTask(TimePoint time, std::function<void()> task) noexcept = 0;
+    // Current time of the executor clock.
+    virtual TimePoint now() const noexcept = 0;
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "threads/Executor.h"
+#include "threads/TimerQueue.h"
 #include "common/macros.h"
 
 #include <functional>
@@ -9,9 +11,10 @@
 #include <condition_variable>
 
 #include <queue>
+#include <vector>
 #include <iostream>
 
-class SingleThread {
+class SingleThread : public Executor {
 public:
     SingleThread() {
         thread_ = std::thread([this] {
@@ -19,18 +22,34 @@ public:
                 std::function<void()> task;
                 {
                     std::unique_lock<std::mutex> lock(queue_mutex_);
-                    cv_.wait(lock, [this] {return !tasks_.empty() || STOP == state_ || FINISH_AND_STOP == state_;});
-                    if (STOP == state_ || (tasks_.empty() && FINISH_AND_STOP == state_)) {
-                        break;
+                    while(true) {
+                        if (STOP == state_ || (tasks_.empty() && FINISH_AND_STOP == state_)) {
+                            return;
+                        }
+
+                        // Move due timers into the tasks queue
+                        timed_tasks_.popDue(Clock::now(), [this](std::function<void()>&& task) {
+                            tasks_.emplace(std::move(task));
+                        });
+
+                        if (!tasks_.empty()) {
+                            break;
+                        }
+
+                        if (timed_tasks_.empty()) {
+                            cv_.wait(lock);
+                        } else {
+                            cv_.wait_until(lock, timed_tasks_.nextTime());
+                        }
                     }
-                    
+
                     task = std::move(tasks_.front());
                     tasks_.pop();
                 }
 
                 task();
-            }   
-        }); 
+            }
+        });
     }
 
     ~SingleThread() {
@@ -38,7 +57,9 @@ public:
             std::unique_lock<std::mutex> lock(queue_mutex_);
             // TODO: add configuration to handle both cases
             //state_ = STOP;
+            // Pending timers are dropped, only already queued tasks are finished.
             state_ = FINISH_AND_STOP;
+            timed_tasks_.stop();
         }
 
         cv_.notify_one();
@@ -46,7 +67,7 @@ public:
         thread_.join();
     }
 
-    void addTask(std::function<void()> task) noexcept {
+    void addTask(std::function<void()> task) noexcept override {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             tasks_.emplace(std::move(task));
@@ -54,12 +75,26 @@ public:
 
         cv_.notify_one();
     }
+
+    void addTimedTask(TimePoint time, std::function<void()> task) noexcept override {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            timed_tasks_.push(time, std::move(task));
+        }
+
+        cv_.notify_one();
+    }
+
+    TimePoint now() const noexcept override {
+        return Clock::now();
+    }
 private:
     std::thread thread_;
     std::queue<std::function<void()>> tasks_;
+    TimerQueue<> timed_tasks_;
     std::mutex queue_mutex_;
     std::condition_variable cv_;
-    
+
     enum State {
         RUN,
         STOP,
@@ -67,4 +102,4 @@ private:
     };
 
     State state_ = RUN;
-};
\ No newline at end of file
+};
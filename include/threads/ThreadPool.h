@@ -7,6 +7,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <semaphore>
 
 #include <queue>
 #include <iostream>
@@ -103,7 +104,7 @@ public:
         }
 
         // wait for jobs to get done 
-        for(size_t i = 0; i < jobs_count; ++i) {
+        for(int i = 0; i < jobs_count; ++i) {
             cs_done.acquire();
         }
     }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "threads/Executor.h"
+#include "common/macros.h"
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Timed tasks of an executor, ordered by time, tasks with equal time keep the submission order.
+// After stop() all timers are dropped and new ones are ignored.
+// Not thread safe, guarded by the executor mutex.
+template<typename TaskT = std::function<void()>>
+class TimerQueue {
+public:
+    using TimePoint = Executor::TimePoint;
+
+    void push(TimePoint time, TaskT task) {
+        if UNLIKELY(stopped_) {
+            return;
+        }
+
+        timers_.push({time, count_++, std::move(task)});
+    }
+
+    bool empty() const noexcept {
+        return timers_.empty();
+    }
+
+    // Time of the earliest timer, expects the queue to be not empty.
+    TimePoint nextTime() const noexcept {
+        return timers_.top().time_;
+    }
+
+    // Pass the tasks with time <= the given time into consumer, in order.
+    template<typename ConsumerT>
+    void popDue(TimePoint time, ConsumerT&& consumer) {
+        while(!timers_.empty() && timers_.top().time_ <= time) {
+            consumer(std::move(timers_.top().task_));
+            timers_.pop();
+        }
+    }
+
+    // Drop the tasks matching the predicate.
+    template<typename PredicateT>
+    void removeIf(PredicateT&& predicate) {
+        Queue timers;
+        while(!timers_.empty()) {
+            const auto& timer = timers_.top();
+            if (!predicate(timer.task_)) {
+                timers.push({timer.time_, timer.order_, std::move(timer.task_)});
+            }
+            timers_.pop();
+        }
+
+        std::swap(timers, timers_);
+    }
+
+    void stop() noexcept {
+        stopped_ = true;
+        timers_ = {};
+    }
+private:
+    struct Timer {
+        TimePoint time_;
+        size_t order_;  // keeps submission order for equal times
+        mutable TaskT task_;
+
+        friend bool operator > (const Timer& left, const Timer& right) {
+            return left.time_ > right.time_ || (left.time_ == right.time_ && left.order_ > right.order_);
+        }
+    };
+
+    using Queue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>;
+
+    Queue timers_;
+    size_t count_ = 0;
+    bool stopped_ = false;
+};
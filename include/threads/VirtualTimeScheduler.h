@@ -0,0 +1,192 @@
+#pragma once
+
+#include "threads/Executor.h"
+#include "threads/TimerQueue.h"
+#include "common/macros.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+#include <queue>
+#include <vector>
+
+// Deterministic scheduler with a virtual clock.
+// Every executor made by the scheduler is a serial task queue (one per node), all of them
+// are executed on the thread that calls run...() methods. When no task is ready, the clock
+// jumps straight to the next timer, so timers never wait for the wall clock.
+// The interleaving of the queues is chosen by a random generator, initialized by the seed,
+// so the same seed and the same inputs always give the same execution order.
+// The scheduler must outlive all its executors.
+class VirtualTimeScheduler {
+public:
+    using TimePoint = Executor::TimePoint;
+    using Duration = Executor::Duration;
+
+    VirtualTimeScheduler(uint64_t seed = 0, TimePoint start_time = TimePoint())
+    : random_generator_(seed)
+    , now_(start_time) {
+    }
+
+    // Create a new serial task queue, to be passed into AsyncNode constructor.
+    std::shared_ptr<Executor> makeExecutor() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        strands_.emplace_back();
+        closed_strands_.push_back(false);
+        return std::make_shared<StrandExecutor>(this, strands_.size() - 1);
+    }
+
+    TimePoint now() const noexcept {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return now_;
+    }
+
+    // Execute tasks until there is no task or timer left. Returns the number of executed tasks.
+    // Never returns if any node has a periodic timer, use runFor()/runUntil() in that case.
+    size_t run() {
+        return runTasks(TimePoint::max());
+    }
+
+    // Execute tasks for the given amount of virtual time. Returns the number of executed tasks.
+    size_t runFor(Duration duration) {
+        return runUntil(now() + duration);
+    }
+
+    // Execute tasks and timers up to the given virtual time inclusively, then set the clock to it.
+    // Returns the number of executed tasks.
+    size_t runUntil(TimePoint time) {
+        const size_t count = runTasks(time);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (now_ < time) {
+            now_ = time;
+        }
+
+        return count;
+    }
+private:
+    class StrandExecutor : public Executor {
+    public:
+        StrandExecutor(VirtualTimeScheduler* scheduler, size_t strand_id)
+        : scheduler_(scheduler)
+        , strand_id_(strand_id) {
+        }
+
+        // Tasks and timers of the strand refer to its node, so they are dropped with the executor
+        ~StrandExecutor() {
+            scheduler_->closeStrand(strand_id_);
+        }
+
+        void addTask(std::function<void()> task) noexcept override {
+            scheduler_->addTask(strand_id_, std::move(task));
+        }
+
+        void addTimedTask(TimePoint time, std::function<void()> task) noexcept override {
+            scheduler_->addTimedTask(strand_id_, time, std::move(task));
+        }
+
+        TimePoint now() const noexcept override {
+            return scheduler_->now();
+        }
+    private:
+        VirtualTimeScheduler* scheduler_;
+        size_t strand_id_;
+    };
+
+    struct StrandTask {
+        size_t strand_id_;
+        std::function<void()> task_;
+    };
+
+    mutable std::mutex mutex_;
+    std::mt19937_64 random_generator_;
+    TimePoint now_;
+    std::vector<std::queue<std::function<void()>>> strands_;
+    std::vector<bool> closed_strands_;
+    std::vector<size_t> ready_strands_; // ids of non empty strands
+    TimerQueue<StrandTask> timed_tasks_;
+
+    void addTask(size_t strand_id, std::function<void()> task) noexcept {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pushTask(strand_id, std::move(task));
+    }
+
+    void addTimedTask(size_t strand_id, TimePoint time, std::function<void()> task) noexcept {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if UNLIKELY(closed_strands_[strand_id]) {
+            return;
+        }
+
+        timed_tasks_.push(time, {strand_id, std::move(task)});
+    }
+
+    void closeStrand(size_t strand_id) noexcept {
+        std::unique_lock<std::mutex> lock(mutex_);
+        closed_strands_[strand_id] = true;
+        strands_[strand_id] = {};
+
+        auto itr = std::find(ready_strands_.begin(), ready_strands_.end(), strand_id);
+        if (ready_strands_.end() != itr) {
+            *itr = ready_strands_.back();
+            ready_strands_.pop_back();
+        }
+
+        timed_tasks_.removeIf([strand_id](const StrandTask& task) {return task.strand_id_ == strand_id;});
+    }
+
+    // Expects mutex_ to be locked
+    void pushTask(size_t strand_id, std::function<void()> task) {
+        if UNLIKELY(closed_strands_[strand_id]) {
+            return;
+        }
+
+        auto& strand = strands_[strand_id];
+        if (strand.empty()) {
+            ready_strands_.push_back(strand_id);
+        }
+
+        strand.emplace(std::move(task));
+    }
+
+    size_t runTasks(TimePoint limit) {
+        size_t count = 0;
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (ready_strands_.empty()) {
+                    // System is idle, advance the clock to the next timer
+                    if (timed_tasks_.empty() || timed_tasks_.nextTime() > limit) {
+                        break;
+                    }
+
+                    now_ = std::max(now_, timed_tasks_.nextTime());
+                }
+
+                // Move due timers into the strands
+                timed_tasks_.popDue(now_, [this](StrandTask&& task) {
+                    pushTask(task.strand_id_, std::move(task.task_));
+                });
+
+                // Select the strand to run, std::mt19937_64 output is the same on all platforms
+                const size_t index = random_generator_() % ready_strands_.size();
+                auto& strand = strands_[ready_strands_[index]];
+                task = std::move(strand.front());
+                strand.pop();
+
+                if (strand.empty()) {
+                    ready_strands_[index] = ready_strands_.back();
+                    ready_strands_.pop_back();
+                }
+            }
+
+            task();
+            ++count;
+        }
+
+        return count;
+    }
+};
@@ -1,4 +1,5 @@
 #include "async_framework/AsyncNode.h"
+#include "common/Logger.h"
 
 static std::shared_ptr<AsyncSystem> system_;
 
@@ -10,6 +11,15 @@ std::shared_ptr<AsyncSystem> AsyncSystem::getInstance() {
     return system_;
 }
 
+std::shared_ptr<ThreadPool> AsyncSystem::getThreadPool() {
+    std::unique_lock<std::mutex> lock(thread_pool_mutex_);
+    if UNLIKELY(!thread_pool_) {
+        thread_pool_ = std::make_shared<ThreadPool>();
+    }
+
+    return thread_pool_;
+}
+
 size_t AsyncSystem::addPublisher(const std::string& topic_name) {
     const size_t topic_id = hash_function_(topic_name);
 
@@ -66,7 +76,8 @@ void AsyncSystem::sendMessage(size_t topic_id, MessageBasePtr msg) noexcept {
             subscriber->writeMessage(msg);
         }
     } else {
-        //TODO: log invalid pub topic_id 
+        LOG_RATE_LIMITED(LogLevel::WARNING, std::chrono::seconds(1), 
+            "AsyncSystem::sendMessage(...): No subscribers for topic ID {}.", topic_id);
     }
 };
 
@@ -75,7 +86,8 @@ void AsyncSystem::sendRequest(PairID request_id, MessageBasePtr request) noexcep
     if (responders_.end() != itr) {
         itr->second->writeRequest(request_id, std::move(request));
     } else {
-        //TODO: log invalid request topic_id
+        LOG_RATE_LIMITED(LogLevel::WARNING, std::chrono::seconds(1), 
+            "AsyncSystem::sendRequest(...): No responder for request topic ID {}.", request_id.first_);
     }
 }
 
@@ -84,16 +96,143 @@ void AsyncSystem::sendResponse(PairID request_id, MessageBasePtr request, Messag
     if (requesters_.end() != itr) {
         itr->second->writeResponse(std::move(request), std::move(responce));
     } else {
-        //TODO: log invalid request topic_id
+        LOG_RATE_LIMITED(LogLevel::WARNING, std::chrono::seconds(1), 
+            "AsyncSystem::sendResponse(...): No requester for request ID {}:{}.", request_id.first_, request_id.second_);
+    }
+}
+
+
+CallbackGroup::CallbackGroup(Type type, Executor* executor, std::shared_ptr<ThreadPool> thread_pool)
+: type_(type)
+, executor_(executor)
+, thread_pool_(std::move(thread_pool)) {
+    ASSERT(MUTUALLY_EXCLUSIVE == type_ || thread_pool_ != nullptr, 
+        "CallbackGroup::CallbackGroup(...): Reentrant group requires a thread pool.");
+}
+
+void CallbackGroup::addTask(std::function<void()> task) noexcept {
+    if (MUTUALLY_EXCLUSIVE == type_) {
+        executor_->addTask(std::move(task));
+        return;
+    }
+
+    {
+        // Under the lock to not start a task after shutdown()
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        if UNLIKELY(closed_) {
+            return;
+        }
+
+        ++tasks_in_flight_;
     }
+
+    thread_pool_->enqueue([this, task = std::move(task)]() mutable {
+        task();
+        // Release the handler and the message before shutdown() can return
+        task = nullptr;
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        if (0 == --tasks_in_flight_) {
+            wait_cv_.notify_all();
+        }
+    });
+}
+
+void CallbackGroup::shutdown() noexcept {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    closed_ = true;
+    wait_cv_.wait(lock, [this] {return 0 == tasks_in_flight_;});
 }
 
 
-AsyncNode::AsyncNode() 
-: SingleThread()
-, system_(AsyncSystem::getInstance())  {
+AsyncNode::AsyncNode(std::shared_ptr<Executor> executor) 
+: system_(AsyncSystem::getInstance())
+, executor_(std::move(executor))
+, timer_token_(std::make_shared<TimerToken>()) {
+    ASSERT(executor_ != nullptr, "AsyncNode::AsyncNode(...): Invalid executor.");
 } 
 
+AsyncNode::~AsyncNode() {
+    shutdownCallbackGroups();
+
+    // Waits for the running timer callback
+    std::unique_lock<std::recursive_mutex> lock(timer_token_->mutex_);
+    timer_token_->alive_ = false;
+}
+
+void AsyncNode::shutdownCallbackGroups() noexcept {
+    for(auto& group : callback_groups_) {
+        group->shutdown();
+    }
+}
+
+void AsyncNode::addTask(std::function<void()> task) noexcept {
+    executor_->addTask(std::move(task));
+}
+
+void AsyncNode::addTask(std::function<void()> task, CallbackGroup* group) noexcept {
+    if (group) {
+        group->addTask(std::move(task));
+    } else {
+        executor_->addTask(std::move(task));
+    }
+}
+
+std::shared_ptr<CallbackGroup> AsyncNode::createCallbackGroup(
+    CallbackGroup::Type type, 
+    std::shared_ptr<ThreadPool> thread_pool) 
+{
+    if (CallbackGroup::REENTRANT == type && !thread_pool) {
+        thread_pool = system_->getThreadPool();
+    }
+
+    auto group = std::make_shared<CallbackGroup>(type, executor_.get(), std::move(thread_pool));
+    callback_groups_.push_back(group);
+    return group;
+}
+
+AsyncNode::TimePoint AsyncNode::now() const noexcept {
+    return executor_->now();
+}
+
+void AsyncNode::addTimer(Duration period, std::function<void()> callback) {
+    ASSERT(period > Duration::zero(), "AsyncNode::addTimer(...): Invalid timer period.");
+    scheduleTimer(
+        executor_.get(), 
+        timer_token_, 
+        now() + period, 
+        period, 
+        std::make_shared<std::function<void()>>(std::move(callback)));
+}
+
+void AsyncNode::scheduleTimer(
+    Executor* executor, 
+    std::shared_ptr<TimerToken> token, 
+    TimePoint time, 
+    Duration period, 
+    std::shared_ptr<std::function<void()>> callback) 
+{
+    // The task runs on the executor, so the executor is alive, but the node may be not
+    auto task_body = [executor, token, time, period, callback]() {
+        std::unique_lock<std::recursive_mutex> lock(token->mutex_);
+        if UNLIKELY(!token->alive_) {
+            return;
+        }
+
+        (*callback)();
+        // Fixed rate, next time is computed from the scheduled time to avoid drift
+        scheduleTimer(executor, token, time + period, period, callback);
+    };
+
+    executor->addTimedTask(time, task_body);
+}
+
+size_t AsyncNode::messagePoolCapacity(size_t topic_id) const {
+    auto itr = message_pools_.find(topic_id);
+    ASSERT(message_pools_.end() != itr, "AsyncNode::messagePoolCapacity(...): No message pool for the topic ID.");
+    return itr->second->capacity();
+}
+
 size_t AsyncNode::addPublisher(const std::string& topic_name) {
     return system_->addPublisher(topic_name);
 }
@@ -0,0 +1,201 @@
+#include "common/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+// Single producer/single consumer ring of log records, one per logging thread
+class Logger::LogRing {
+public:
+    LogRing()
+    : records_(RING_SIZE) {
+    }
+
+    // Called by the owner thread only
+    bool push(const LogRecord& record) noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if UNLIKELY(head - tail_cache_ == RING_SIZE) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ == RING_SIZE) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        records_[head & (RING_SIZE - 1)] = record;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer only
+    void popAll(std::vector<LogRecord>& records) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        while(tail != head) {
+            records.push_back(records_[tail & (RING_SIZE - 1)]);
+            ++tail;
+        }
+
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    std::atomic<bool> closed_ = false;  // owner thread has finished
+    std::atomic<uint64_t> dropped_ = 0;
+private:
+    alignas(64) std::atomic<size_t> head_ = 0;
+    size_t tail_cache_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+    std::vector<LogRecord> records_;
+};
+
+Logger& Logger::getInstance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+: output_(&std::cerr) {
+    thread_ = std::thread([this] {this->run();});
+}
+
+Logger::~Logger() {
+    {
+        std::unique_lock<std::mutex> lock(thread_mutex_);
+        stop_ = true;
+    }
+
+    cv_.notify_one();
+
+    thread_.join();
+}
+
+void Logger::setOutput(std::ostream* output) {
+    ASSERT(output != nullptr, "Logger::setOutput(...): Invalid output stream.");
+    std::unique_lock<std::mutex> lock(output_mutex_);
+    output_ = output;
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(output_mutex_);
+    writeRecords();
+}
+
+void Logger::push(const LogRecord& record) noexcept {
+    threadRing().push(record);
+}
+
+Logger::LogRing& Logger::threadRing() {
+    // Marks the ring as closed on the thread exit, the consumer removes it after the last records are written
+    struct ThreadRing {
+        std::shared_ptr<LogRing> ring_;
+
+        ~ThreadRing() {
+            if (ring_) {
+                ring_->closed_.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local ThreadRing thread_ring;
+    if UNLIKELY(!thread_ring.ring_) {
+        thread_ring.ring_ = std::make_shared<LogRing>();
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        rings_.push_back(thread_ring.ring_);
+    }
+
+    return *thread_ring.ring_;
+}
+
+void Logger::run() {
+    while(true) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(thread_mutex_);
+            cv_.wait_for(lock, FLUSH_PERIOD, [this] {return stop_;});
+            stop = stop_;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(output_mutex_);
+            writeRecords();
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+void Logger::writeRecords() {
+    uint64_t dropped = 0;
+    {
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        auto itr = rings_.begin();
+        while(itr != rings_.end()) {
+            LogRing& ring = **itr;
+            const bool closed = ring.closed_.load(std::memory_order_acquire);
+            ring.popAll(batch_);
+            dropped += ring.dropped_.exchange(0, std::memory_order_relaxed);
+            itr = closed ? rings_.erase(itr) : itr + 1;
+        }
+    }
+
+    if LIKELY(batch_.empty() && 0 == dropped) {
+        return;
+    }
+
+    // Records of different threads are ordered by time
+    std::stable_sort(batch_.begin(), batch_.end(), [](const LogRecord& left, const LogRecord& right) {
+        return left.time_ns_ < right.time_ns_;
+    });
+
+    if UNLIKELY(dropped > 0) {
+        *output_ << "Logger: " << dropped << " records dropped, ring is full.\n";
+    }
+
+    for(const auto& record : batch_) {
+        writeRecord(record);
+    }
+
+    batch_.clear();
+    output_->flush();
+}
+
+void Logger::writeRecord(const LogRecord& record) {
+    static const char* level_names[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+    const LogSite& site = *record.site_;
+    const char* file_name = std::strrchr(site.file_, '/');
+    file_name = file_name ? file_name + 1 : site.file_;
+
+    auto& output = *output_;
+    output << "[" << std::fixed << std::setprecision(6) << record.time_ns_ * 1e-9 << "] "
+        << level_names[static_cast<size_t>(site.level_)] << " " << file_name << ":" << site.line_ << ": ";
+    output.unsetf(std::ios_base::floatfield);
+
+    // Substitute "{}" placeholders
+    size_t arg_index = 0;
+    for(const char* c = site.format_; *c != '\0'; ++c) {
+        if ('{' == c[0] && '}' == c[1] && arg_index < record.args_count_) {
+            const LogArg& arg = record.args_[arg_index++];
+            switch(arg.type_) {
+                case LogArg::BOOL: output << (arg.bool_ ? "true" : "false"); break;
+                case LogArg::INT: output << arg.int_; break;
+                case LogArg::UINT: output << arg.uint_; break;
+                case LogArg::DOUBLE: output << arg.double_; break;
+                case LogArg::STRING: output << (arg.string_ ? arg.string_ : "(null)"); break;
+                case LogArg::POINTER: output << arg.pointer_; break;
+            }
+            ++c;
+        } else {
+            output << *c;
+        }
+    }
+
+    if (record.suppressed_ > 0) {
+        output << " (" << record.suppressed_ << " similar records suppressed)";
+    }
+
+    output << "\n";
+}
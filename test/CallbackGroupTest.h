@@ -0,0 +1,128 @@
+#pragma once
+
+#include <async_framework/AsyncNode.h>
+#include <threads/ThreadPool.h>
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+
+class CallbackGroupMessage : public MessageBase {
+public:
+    u_int64_t data_uint_;
+};
+
+class SlowSubscriberNode : public AsyncNode {
+public:
+    using SubscriberT = AsyncSubscriber<CallbackGroupMessage>;
+    using MessagePtrT = std::shared_ptr<CallbackGroupMessage>;
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    SlowSubscriberNode(std::shared_ptr<ThreadPool> thread_pool, size_t count)
+    : count_limit_(count) {
+        auto reentrant_group = createCallbackGroup(CallbackGroup::REENTRANT, std::move(thread_pool));
+        auto on_slow_msg_body = [this](const MessagePtrT& msg) {this->slowMsgHandler(msg);};
+        addSubscriber("callback_group_slow_msg", std::make_shared<SubscriberT>(this, on_slow_msg_body, reentrant_group));
+
+        auto on_msg_body = [this](const MessagePtrT& msg) {this->msgHandler(msg);};
+        addSubscriber("callback_group_msg", std::make_shared<SubscriberT>(this, on_msg_body));
+    }
+
+    ~SlowSubscriberNode() {
+        // Reentrant handlers use members of this class
+        shutdownCallbackGroups();
+    }
+
+    // Time when all messages of the kind are handled
+    TimePoint slowDoneTime() const {
+        return slow_done_time_;
+    }
+
+    TimePoint doneTime() const {
+        return done_time_;
+    }
+
+    size_t maxConcurrency() const {
+        return max_concurrency_;
+    }
+
+    size_t slowCount() const {
+        return slow_count_;
+    }
+
+    size_t count() const {
+        return count_;
+    }
+private:
+    std::atomic<size_t> concurrency_ = 0;
+    std::atomic<size_t> max_concurrency_ = 0;
+    std::atomic<size_t> slow_count_ = 0;
+    std::atomic<size_t> count_ = 0;
+    const size_t count_limit_;
+    std::atomic<TimePoint> slow_done_time_ = TimePoint::max();
+    std::atomic<TimePoint> done_time_ = TimePoint::max();
+
+    void slowMsgHandler(const MessagePtrT&) {
+        const size_t concurrency = ++concurrency_;
+        size_t max_concurrency = max_concurrency_;
+        while(concurrency > max_concurrency && !max_concurrency_.compare_exchange_weak(max_concurrency, concurrency)) {
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --concurrency_;
+        if (count_limit_ == ++slow_count_) {
+            slow_done_time_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    void msgHandler(const MessagePtrT&) {
+        if (count_limit_ == ++count_) {
+            done_time_ = std::chrono::steady_clock::now();
+        }
+    }
+};
+
+class CallbackGroupPublisherNode : public AsyncNode {
+public:
+    CallbackGroupPublisherNode() {
+        slow_publisher_id_ = AsyncNode::addPublisher("callback_group_slow_msg");
+        publisher_id_ = AsyncNode::addPublisher("callback_group_msg");
+    }
+
+    void sendMessages(size_t count) {
+        for(size_t i = 0; i < count; ++i) {
+            auto msg = std::make_shared<CallbackGroupMessage>();
+            msg->data_uint_ = i;
+            AsyncNode::sendMessage(slow_publisher_id_, msg);
+            AsyncNode::sendMessage(publisher_id_, std::move(msg));
+        }
+    }
+private:
+    size_t slow_publisher_id_;
+    size_t publisher_id_;
+};
+
+void CallbackGroupTest() {
+    const size_t count = 16;
+    auto thread_pool = std::make_shared<ThreadPool>(4);
+
+    SlowSubscriberNode sub_node(thread_pool, count);
+    CallbackGroupPublisherNode pub_node;
+
+    const auto begin = std::chrono::steady_clock::now();
+    const auto deadline = begin + std::chrono::seconds(5);
+    pub_node.sendMessages(count);
+    while(sub_node.slowCount() < count || sub_node.count() < count) {
+        ASSERT(std::chrono::steady_clock::now() < deadline, "CallbackGroupTest: messages are not handled in time.");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout << "CallbackGroup - " << count << " slow messages in " 
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms, max concurrency " 
+        << sub_node.maxConcurrency() << std::endl;
+
+    ASSERT(sub_node.maxConcurrency() > 1, "CallbackGroupTest: reentrant handlers are not executed in parallel.");
+    ASSERT(sub_node.doneTime() < sub_node.slowDoneTime(), "CallbackGroupTest: exclusive handlers are blocked by reentrant ones.");
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <async_framework/AsyncNode.h>
+#include <threads/EpollThread.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cerrno>
+
+#include <iostream>
+#include <atomic>
+#include <thread>
+
+class EpollMessage : public MessageBase {
+public:
+    u_int64_t data_uint_;
+};
+
+// Reads bytes from the pipe and receives messages on the same node thread
+class PipeReaderNode : public AsyncNode {
+public:
+    using SubscriberT = AsyncSubscriber<EpollMessage>;
+    using MessagePtrT = std::shared_ptr<EpollMessage>;
+
+    PipeReaderNode(std::shared_ptr<EpollThread> epoll_thread, int fd)
+    : AsyncNode(epoll_thread)
+    , epoll_thread_(std::move(epoll_thread))
+    , fd_(fd) {
+        auto on_msg_body = [this](const MessagePtrT& msg) {this->msgHandler(msg);};
+        addSubscriber("epoll_msg", std::make_shared<SubscriberT>(this, on_msg_body));
+        ASSERT(epoll_thread_->addFd(fd_, EPOLLIN, [this](uint32_t events) {this->readHandler(events);}),
+            "PipeReaderNode: Failed to register fd.");
+    }
+
+    ~PipeReaderNode() {
+        epoll_thread_->removeFd(fd_);
+    }
+
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    size_t messages() const {
+        return messages_;
+    }
+
+    bool sameThread() const {
+        return same_thread_;
+    }
+private:
+    std::shared_ptr<EpollThread> epoll_thread_;
+    int fd_;
+    std::thread::id thread_id_;
+    std::atomic<size_t> bytes_ = 0;
+    std::atomic<size_t> messages_ = 0;
+    std::atomic<bool> same_thread_ = true;
+
+    void checkThread() {
+        if (std::thread::id() == thread_id_) {
+            thread_id_ = std::this_thread::get_id();
+        } else if (thread_id_ != std::this_thread::get_id()) {
+            same_thread_ = false;
+        }
+    }
+
+    void readHandler(uint32_t) {
+        checkThread();
+        char buffer[64];
+        const auto size = read(fd_, buffer, sizeof(buffer));
+        if (size > 0) {
+            bytes_ += size;
+        }
+    }
+
+    void msgHandler(const MessagePtrT&) {
+        checkThread();
+        ++messages_;
+    }
+};
+
+class EpollPublisherNode : public AsyncNode {
+public:
+    EpollPublisherNode() {
+        publisher_id_ = AsyncNode::addPublisher("epoll_msg");
+    }
+
+    void sendMessages(size_t count) {
+        for(size_t i = 0; i < count; ++i) {
+            auto msg = std::make_shared<EpollMessage>();
+            msg->data_uint_ = i;
+            AsyncNode::sendMessage(publisher_id_, std::move(msg));
+        }
+    }
+private:
+    size_t publisher_id_;
+};
+
+void EpollThreadTest() {
+    int pipe_fds[2];
+    ASSERT(0 == pipe2(pipe_fds, O_NONBLOCK), "EpollThreadTest: Failed to create pipe.");
+
+    const size_t count = 100;
+    {
+        PipeReaderNode reader_node(std::make_shared<EpollThread>(), pipe_fds[0]);
+        EpollPublisherNode pub_node;
+
+        for(size_t i = 0; i < count; ++i) {
+            ASSERT(1 == write(pipe_fds[1], "x", 1), "EpollThreadTest: Failed to write into pipe.");
+        }
+        pub_node.sendMessages(count);
+
+        // Timers wake up the epoll wait too
+        std::atomic<bool> timer_fired = false;
+        auto epoll_thread = std::make_shared<EpollThread>();
+        epoll_thread->addTimedTask(epoll_thread->now() + std::chrono::milliseconds(10), [&] {timer_fired = true;});
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while(reader_node.bytes() < count || reader_node.messages() < count || !timer_fired) {
+            ASSERT(std::chrono::steady_clock::now() < deadline, "EpollThreadTest: data, messages or timer are not received.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::cout << "EpollThread - " << reader_node.bytes() << " bytes, " << reader_node.messages() << " messages" << std::endl;
+        ASSERT(reader_node.sameThread(), "EpollThreadTest: handlers are executed on different threads.");
+    }
+
+    // Duplicate registration keeps the first handler
+    {
+        std::atomic<size_t> first_count = 0;
+        std::atomic<size_t> second_count = 0;
+        EpollThread epoll_thread;
+        ASSERT(epoll_thread.addFd(pipe_fds[0], EPOLLIN, [&](uint32_t) {
+            char buffer[64];
+            if (read(pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+                ++first_count;
+            }
+        }), "EpollThreadTest: Failed to register fd.");
+        ASSERT(!epoll_thread.addFd(pipe_fds[0], EPOLLIN, [&](uint32_t) {++second_count;}) && EEXIST == errno, 
+            "EpollThreadTest: Duplicate fd registration is accepted.");
+
+        ASSERT(1 == write(pipe_fds[1], "x", 1), "EpollThreadTest: Failed to write into pipe.");
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while(0 == first_count) {
+            ASSERT(std::chrono::steady_clock::now() < deadline, "EpollThreadTest: first handler is not called.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ASSERT(epoll_thread.removeFd(pipe_fds[0]), "EpollThreadTest: Failed to remove fd.");
+        ASSERT(0 == second_count, "EpollThreadTest: second handler is called.");
+    }
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
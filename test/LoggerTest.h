@@ -0,0 +1,75 @@
+#pragma once
+
+#include <async_framework/AsyncNode.h>
+#include <common/Logger.h>
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <x86intrin.h> // gcc specific, for __rdtsc() - CPU counter
+
+void LoggerTest() {
+    std::stringstream output;
+    Logger& logger = Logger::getInstance();
+    logger.flush();
+    logger.setOutput(&output);
+
+    // Hot path cost
+    const size_t count = 100;
+    auto begin = __rdtsc();
+    for(size_t i = 0; i < count; ++i) {
+        LOG_INFO("LoggerTest: record {} of {}, {} {}", i, count, 0.5, "text");
+    }
+    auto end = __rdtsc();
+    std::cout << "Logger - " << (end - begin) / count << std::endl;
+
+    // Enums are logged as their underlying type
+    enum class SignedEnum : int8_t {NEGATIVE = -3};
+    LOG_INFO("LoggerTest: enum {}", SignedEnum::NEGATIVE);
+
+    // Records from several threads
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i) {
+        threads.emplace_back([i] {LOG_WARNING("LoggerTest: thread {}", i);});
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    // Rate limited records of unknown topic
+    for(size_t i = 0; i < count; ++i) {
+        AsyncSystem::getInstance()->sendMessage(0, nullptr);
+    }
+
+    // Skipped records are reported with the next one
+    for(size_t i = 0; i < 11; ++i) {
+        if (10 == i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        }
+        LOG_RATE_LIMITED(LogLevel::INFO, std::chrono::milliseconds(50), "LoggerTest: rate limited record.");
+    }
+
+    logger.flush();
+    logger.setOutput(&std::cerr);
+
+    auto countOf = [](const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for(size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    };
+
+    const std::string text = output.str();
+    ASSERT(text.find("INFO LoggerTest.h") != std::string::npos, "LoggerTest: invalid record header.");
+    ASSERT(text.find("LoggerTest: record 99 of 100, 0.5 text") != std::string::npos, "LoggerTest: invalid record format.");
+    for(int i = 0; i < 4; ++i) {
+        ASSERT(text.find("LoggerTest: thread " + std::to_string(i)) != std::string::npos, "LoggerTest: thread record is lost.");
+    }
+    ASSERT(text.find("LoggerTest: enum -3") != std::string::npos, "LoggerTest: invalid enum format.");
+    ASSERT(1 == countOf(text, "No subscribers for topic ID 0."), "LoggerTest: unknown topic is not rate limited.");
+    ASSERT(2 == countOf(text, "LoggerTest: rate limited record."), "LoggerTest: invalid number of rate limited records.");
+    ASSERT(1 == countOf(text, "LoggerTest: rate limited record. (9 similar records suppressed)"), 
+        "LoggerTest: suppressed records are not reported.");
+}
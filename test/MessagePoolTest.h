@@ -0,0 +1,89 @@
+#pragma once
+
+#include <async_framework/AsyncNode.h>
+#include <async_framework/MessagePool.h>
+#include <threads/VirtualTimeScheduler.h>
+
+#include <eigen3/Eigen/Core>
+
+#include <iostream>
+#include <chrono>
+
+// Large payload message
+class MatrixMessage : public MessageBase {
+public:
+    u_int64_t count_;
+    Eigen::Matrix<float, 64, 64> matrix_;
+};
+
+class MatrixPublisherNode : public AsyncNode {
+public:
+    MatrixPublisherNode(std::shared_ptr<Executor> executor, size_t pool_size)
+    : AsyncNode(std::move(executor)) {
+        publisher_id_ = AsyncNode::addPublisher<MatrixMessage>("matrix_msg", pool_size);
+        AsyncNode::addTimer(std::chrono::milliseconds(10), [this]() {this->onTimer();});
+    }
+
+    size_t poolCapacity() const {
+        return AsyncNode::messagePoolCapacity(publisher_id_);
+    }
+private:
+    size_t publisher_id_;
+    u_int64_t count_ = 0;
+
+    void onTimer() {
+        auto msg = AsyncNode::loanMessage<MatrixMessage>(publisher_id_);
+        msg->count_ = count_;
+        msg->matrix_.setConstant(static_cast<float>(count_));
+        ++count_;
+        AsyncNode::sendMessage(publisher_id_, std::move(msg));
+    }
+};
+
+class MatrixSubscriberNode : public AsyncNode {
+public:
+    using SubscriberT = AsyncSubscriber<MatrixMessage>;
+    using MessagePtrT = std::shared_ptr<MatrixMessage>;
+
+    MatrixSubscriberNode(std::shared_ptr<Executor> executor)
+    : AsyncNode(std::move(executor)) {
+        auto on_msg_body = [this](const MessagePtrT& msg) {this->msgHandler(msg);};
+        addSubscriber("matrix_msg", std::make_shared<SubscriberT>(this, on_msg_body));
+    }
+
+    size_t count() const {
+        return count_;
+    }
+private:
+    size_t count_ = 0;
+
+    void msgHandler(const MessagePtrT& msg) {
+        ASSERT(0 == reinterpret_cast<uintptr_t>(msg.get()) % 64, "MessagePoolTest: message is not aligned.");
+        ASSERT(msg->matrix_.sum() == msg->count_ * msg->matrix_.size(), "MessagePoolTest: invalid message data.");
+        ++count_;
+    }
+};
+
+void MessagePoolTest() {
+    // Messages return into the pool after release
+    MessagePool<MatrixMessage> pool(2);
+    MatrixMessage* first = pool.loan().get();
+    ASSERT(first == pool.loan().get(), "MessagePoolTest: message is not returned into the pool.");
+    {
+        auto msg_1 = pool.loan();
+        auto msg_2 = pool.loan();
+        auto msg_3 = pool.loan();
+        ASSERT(4 == pool.capacity(), "MessagePoolTest: pool didn't grow.");
+    }
+    ASSERT(4 == pool.available(), "MessagePoolTest: messages are not returned into the pool.");
+
+    // Publisher loans messages in steady state
+    VirtualTimeScheduler scheduler;
+    MatrixPublisherNode pub_node(scheduler.makeExecutor(), 2);
+    MatrixSubscriberNode sub_node(scheduler.makeExecutor());
+    scheduler.runFor(std::chrono::seconds(10));
+
+    std::cout << "MessagePool - " << sub_node.count() << " messages received" << std::endl;
+    ASSERT(1000 == sub_node.count(), "MessagePoolTest: unexpected number of messages.");
+    ASSERT(2 == pub_node.poolCapacity(), "MessagePoolTest: pool grows in steady state.");
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <async_framework/AsyncNode.h>
+#include <threads/VirtualTimeScheduler.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+class VirtualTimeMessage : public MessageBase {
+public:
+    u_int64_t sender_;
+    u_int64_t count_;
+};
+
+class TimerPublisherNode : public AsyncNode {
+public:
+    TimerPublisherNode(std::shared_ptr<Executor> executor, const std::string& topic_name, u_int64_t id, Duration period)
+    : AsyncNode(std::move(executor))
+    , id_(id) {
+        publisher_id_ = AsyncNode::addPublisher(topic_name);
+        AsyncNode::addTimer(period, [this]() {this->onTimer();});
+    }
+private:
+    u_int64_t id_;
+    u_int64_t count_ = 0;
+    size_t publisher_id_;
+
+    void onTimer() {
+        auto msg = std::make_shared<VirtualTimeMessage>();
+        msg->sender_ = id_;
+        msg->count_ = count_++;
+        AsyncNode::sendMessage(publisher_id_, std::move(msg));
+    }
+};
+
+class RecorderNode : public AsyncNode {
+public:
+    using SubscriberT = AsyncSubscriber<VirtualTimeMessage>;
+    using MessagePtrT = std::shared_ptr<VirtualTimeMessage>;
+
+    RecorderNode(std::shared_ptr<Executor> executor, const std::vector<std::string>& topic_names)
+    : AsyncNode(std::move(executor)) {
+        auto on_msg_body = [this](const MessagePtrT& msg) {this->msgHandler(msg);};
+        for(const auto& topic_name : topic_names) {
+            addSubscriber(topic_name, std::make_shared<SubscriberT>(this, on_msg_body));
+        }
+    }
+
+    const std::vector<u_int64_t>& log() const {
+        return log_;
+    }
+
+private:
+    std::vector<u_int64_t> log_;
+
+    void msgHandler(const MessagePtrT& msg) {
+        log_.push_back(msg->sender_ * 1000000 + msg->count_);
+    }
+};
+
+// Runs one hour of virtual time of two timer driven publishers, returns the order of received messages.
+std::vector<u_int64_t> VirtualTimeRun(uint64_t seed, const std::string& run_name) {
+    using namespace std::chrono_literals;
+
+    const std::string topic_1 = "virtual_time_msg_1_" + run_name;
+    const std::string topic_2 = "virtual_time_msg_2_" + run_name;
+
+    // Scheduler must outlive the nodes
+    VirtualTimeScheduler scheduler(seed);
+    // Both timers fire at the same virtual times, so the messages order depends only on the seed
+    TimerPublisherNode pub_node_1(scheduler.makeExecutor(), topic_1, 1, 100ms);
+    TimerPublisherNode pub_node_2(scheduler.makeExecutor(), topic_2, 2, 100ms);
+    RecorderNode rec_node(scheduler.makeExecutor(), {topic_1, topic_2});
+
+    scheduler.runFor(1h);
+
+    return rec_node.log();
+}
+
+// Node with periodic timers slower than their period
+class SlowTimerNode : public AsyncNode {
+public:
+    SlowTimerNode(std::shared_ptr<Executor> executor, Duration period, Duration duration)
+    : AsyncNode(std::move(executor)) {
+        for(int i = 0; i < 2; ++i) {
+            AsyncNode::addTimer(period, [duration]() {std::this_thread::sleep_for(duration);});
+        }
+    }
+};
+
+// Node with a timer using its member
+class CountingTimerNode : public AsyncNode {
+public:
+    CountingTimerNode(std::shared_ptr<Executor> executor, Duration period, std::atomic<size_t>* count)
+    : AsyncNode(std::move(executor))
+    , count_(count) {
+        AsyncNode::addTimer(period, [this]() {++(*this->count_);});
+    }
+private:
+    std::atomic<size_t>* count_;
+};
+
+void TimerShutdownTest() {
+    using namespace std::chrono_literals;
+
+    // Pending timers don't block the node destruction
+    {
+        SlowTimerNode node(std::make_shared<SingleThread>(), 1ms, 3ms);
+        std::this_thread::sleep_for(20ms);
+    }
+
+    // Timers of a destroyed node are not called on the shared executor
+    {
+        std::atomic<size_t> count = 0;
+        auto executor = std::make_shared<SingleThread>();
+        auto node = std::make_unique<CountingTimerNode>(executor, 1ms, &count);
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while(0 == count) {
+            ASSERT(std::chrono::steady_clock::now() < deadline, "TimerShutdownTest: timer is not called.");
+            std::this_thread::sleep_for(1ms);
+        }
+
+        node.reset();
+        const size_t node_count = count;
+        std::this_thread::sleep_for(20ms);
+        ASSERT(node_count == count, "TimerShutdownTest: timer of the destroyed node is called.");
+    }
+
+    // Timers of a destroyed node are dropped from the scheduler
+    VirtualTimeScheduler scheduler;
+    {
+        SlowTimerNode node(scheduler.makeExecutor(), 1ms, 0ms);
+        scheduler.runFor(10ms);
+    }
+    ASSERT(0 == scheduler.run(), "TimerShutdownTest: timers of the destroyed node are executed.");
+}
+
+void VirtualTimeTest() {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto log_1 = VirtualTimeRun(42, "a");
+    const auto end = std::chrono::steady_clock::now();
+    const auto log_2 = VirtualTimeRun(42, "b");
+
+    std::cout << "VirtualTime - 1h simulated in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms, "
+        << log_1.size() << " messages" << std::endl;
+
+    ASSERT(log_1.size() == 2 * 36000, "VirtualTimeTest: unexpected number of messages.");
+    ASSERT(log_1 == log_2, "VirtualTimeTest: execution order is not deterministic.");
+
+    TimerShutdownTest();
+}
@@ -1,6 +1,11 @@
 ﻿
 #include "ThreadPoolTest.h"
 #include "AsyncNodeTest.h"
+#include "VirtualTimeTest.h"
+#include "MessagePoolTest.h"
+#include "CallbackGroupTest.h"
+#include "LoggerTest.h"
+#include "EpollThreadTest.h"
 
 #include <eigen3/Eigen/Core>
 
@@ -12,6 +17,11 @@ int main() {
     //TreadPoolTest();
 
     AsyncNodeTest();
+    VirtualTimeTest();
+    MessagePoolTest();
+    CallbackGroupTest();
+    LoggerTest();
+    EpollThreadTest();
 
     return 0;
 }
\ No newline at end of file